@@ -0,0 +1,204 @@
+/* BSD 3-Clause License
+ *
+ * Copyright (c) 2026, XRG Simulation GmbH
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//////////////////////////////////////////////////////////////////////////////
+//  claradelay_bench: times the delay tables outside of a Modelica tool.    //
+//  every step stores a value and requests a vector of delayed values, the  //
+//  way ExampleClaRaDelay does, once without and once with a delay log.     //
+//  afterwards macro steps are retried from saved states on a long history, //
+//  as a co-simulation master does with fmi2GetFMUstate/fmi2SetFMUstate     //
+//////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../claradelay.h"
+
+#define BENCH_STEPS 1000000
+#define BENCH_DELAYS 5
+#define BENCH_REPEAT 5
+#define BENCH_CYCLES 10000
+#define BENCH_MACRO_STEPS 10
+#define BENCH_COPIES 100
+
+//////////////////////////////////////////////////////////////////////////////
+//  the library expects these from the Modelica tool                        //
+//////////////////////////////////////////////////////////////////////////////
+void ModelicaMessage(const char *string) { fputs(string, stderr); }
+void ModelicaFormatMessage(const char *string, ...) { va_list args; va_start(args, string); vfprintf(stderr, string, args); va_end(args); }
+void ModelicaError(const char *string) { fputs(string, stderr); exit(1); }
+void ModelicaFormatError(const char *string, ...) { va_list args; va_start(args, string); vfprintf(stderr, string, args); va_end(args); exit(1); }
+
+static double runTable(void * table, int firstStep, int steps)
+{
+    double getTimes[BENCH_DELAYS];
+    double result[BENCH_DELAYS];
+    double time;
+    double checksum = 0.0;
+    int i;
+    int t;
+    for (i = firstStep; i < firstStep + steps; i++)
+    {
+        time = i*1e-3;
+        for (t = 0; t < BENCH_DELAYS; t++)
+        {
+            getTimes[t] = time - 0.1*t > 0 ? time - 0.1*t : 0;
+        }
+        clara_getDelayValuesAtTimes(table, time, sin(time), getTimes, BENCH_DELAYS, result, BENCH_DELAYS);
+        checksum += result[BENCH_DELAYS - 1];
+    }
+    return checksum;
+}
+
+static double timeTable(const char * logFileName)
+{
+    clock_t start = clock();
+    void * table = logFileName ? clara_initDelayWithLog(logFileName) : clara_initDelay();
+    runTable(table, 0, BENCH_STEPS);
+    clara_deleteDelay(table);
+    return (double)(clock() - start)/CLOCKS_PER_SEC;
+}
+
+static double timeCycles(void * table, int firstStep, int useStates)
+{
+    clock_t start = clock();
+    void * state = NULL;
+    int step;
+    int c;
+    //////////////////////////////////////////////////////////////////////
+    //  with useStates every cycle saves the table, does a macro step,  //
+    //  restores the table and retries the macro step. without it the   //
+    //  same number of steps is done forward only, which is the         //
+    //  stepping cost contained in a cycle                              //
+    //////////////////////////////////////////////////////////////////////
+    for (c = 0; c < BENCH_CYCLES; c++)
+    {
+        if (useStates)
+        {
+            step = firstStep + c*BENCH_MACRO_STEPS;
+            state = clara_getDelayState(table);
+            runTable(table, step, BENCH_MACRO_STEPS);
+            clara_setDelayState(table, state);
+            runTable(table, step, BENCH_MACRO_STEPS);
+            clara_freeDelayState(state);
+        }
+        else
+        {
+            step = firstStep + 2*c*BENCH_MACRO_STEPS;
+            runTable(table, step, 2*BENCH_MACRO_STEPS);
+        }
+    }
+    return (double)(clock() - start)/CLOCKS_PER_SEC;
+}
+
+static double timeHistoryCopy()
+{
+    clock_t start;
+    double * source = (double *)calloc(2*BENCH_STEPS, sizeof(double));
+    double * copy = (double *)malloc(2*BENCH_STEPS*sizeof(double));
+    int c;
+    //////////////////////////////////////////////////////////////////////
+    //  reference: deep copy of time and value of the whole history     //
+    //////////////////////////////////////////////////////////////////////
+    start = clock();
+    for (c = 0; c < BENCH_COPIES; c++)
+    {
+        memcpy(copy, source, 2*BENCH_STEPS*sizeof(double));
+        source[c] = copy[BENCH_STEPS + c];
+    }
+    start = clock() - start;
+    free(source);
+    free(copy);
+    return (double)start/CLOCKS_PER_SEC;
+}
+
+int main(int argc, char * argv[])
+{
+    const char * logFileName = argc > 1 ? argv[1] : "claradelay_bench.log";
+    double plain = -1.0;
+    double logged = -1.0;
+    double seconds;
+    double stepping;
+    double cycles;
+    void * table;
+    void * reference;
+    int history;
+    int r;
+
+    //////////////////////////////////////////////////////////////////////
+    //  swap the order of both variants every repetition so that heap   //
+    //  state left by the previous run affects them alike, then keep    //
+    //  the best run of each                                            //
+    //////////////////////////////////////////////////////////////////////
+    for (r = 0; r < 2*BENCH_REPEAT; r++)
+    {
+        if (r % 2 == 0)
+        {
+            seconds = timeTable(NULL);
+            if (plain < 0 || seconds < plain) plain = seconds;
+        }
+        seconds = timeTable(logFileName);
+        if (logged < 0 || seconds < logged) logged = seconds;
+        if (r % 2 == 1)
+        {
+            seconds = timeTable(NULL);
+            if (plain < 0 || seconds < plain) plain = seconds;
+        }
+    }
+    printf("steps per run:    %i (best of %i)\n", BENCH_STEPS, 2*BENCH_REPEAT);
+    printf("without log:      %8.1f ns/step\n", plain/BENCH_STEPS*1e9);
+    printf("with delay log:   %8.1f ns/step\n", logged/BENCH_STEPS*1e9);
+    printf("log overhead:     %8.1f %%\n", (logged - plain)/plain*100.0);
+
+    //////////////////////////////////////////////////////////////////////
+    //  states on a short and a long history. reference does the        //
+    //  forward stepping on an identical table, so both start alike     //
+    //////////////////////////////////////////////////////////////////////
+    printf("retried macro steps of %i steps, %i cycles\n", BENCH_MACRO_STEPS, BENCH_CYCLES);
+    for (history = BENCH_STEPS/10; history <= BENCH_STEPS; history *= 10)
+    {
+        table = clara_initDelay();
+        reference = clara_initDelay();
+        runTable(table, 0, history);
+        runTable(reference, 0, history);
+        stepping = timeCycles(reference, history, 0);
+        cycles = timeCycles(table, history, 1);
+        clara_deleteDelay(table);
+        clara_deleteDelay(reference);
+        printf("history %8i:  %8.2f us/cycle get/set state\n", history, (cycles - stepping)/BENCH_CYCLES*1e6);
+    }
+    printf("history copy:     %8.2f us/copy of %i steps\n", timeHistoryCopy()/BENCH_COPIES*1e6, BENCH_STEPS);
+    return 0;
+}
@@ -0,0 +1,422 @@
+/* BSD 3-Clause License
+ *
+ * Copyright (c) 2026, XRG Simulation GmbH
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//////////////////////////////////////////////////////////////////////////////
+//  claradelay_test: checks saved states and the delay log outside of a     //
+//  Modelica tool. returns 0 on success                                     //
+//////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../claradelay.h"
+
+#define TEST_LOG "claradelay_test.log"
+
+static int messages = 0;
+static int failures = 0;
+static int expectError = 0;
+static jmp_buf errorJump;
+
+//////////////////////////////////////////////////////////////////////////////
+//  the library expects these from the Modelica tool                        //
+//////////////////////////////////////////////////////////////////////////////
+void ModelicaMessage(const char *string) { fputs(string, stderr); messages++; }
+void ModelicaFormatMessage(const char *string, ...) { va_list args; va_start(args, string); vfprintf(stderr, string, args); va_end(args); messages++; }
+void ModelicaError(const char *string) { if (expectError) longjmp(errorJump, 1); fputs(string, stderr); exit(1); }
+void ModelicaFormatError(const char *string, ...) { va_list args; if (expectError) longjmp(errorJump, 1); va_start(args, string); vfprintf(stderr, string, args); va_end(args); exit(1); }
+
+static void check(int condition, const char * what)
+{
+    if (!condition)
+    {
+        fprintf(stderr, "FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static double valueAt(void * table, double time, double value, double getTime)
+{
+    return clara_getDelayValuesAtTime(table, time, value, getTime);
+}
+
+static void runSteps(void * table, int firstStep, int lastStep, double value)
+{
+    //////////////////////////////////////////////////////////////////
+    //  step i is stored at time i*0.01 with value i, unless value  //
+    //  is given (>= 0 means use it instead)                        //
+    //////////////////////////////////////////////////////////////////
+    for (int i = firstStep; i < lastStep; i++)
+    {
+        clara_getDelayValuesAtTime(table, i*0.01, value >= 0 ? value : i, i*0.01 - 1.0 > 0 ? i*0.01 - 1.0 : 0);
+    }
+}
+
+static int readLog(const char * fileName, double * logTime, double * logData, int maxRows)
+{
+    FILE * file = fopen(fileName, "rb");
+    char magic[8];
+    int header[2];
+    int rows = 0;
+    //////////////////////////////////////////////////////////////////
+    //  read all samples of the single channel through the block    //
+    //  layout described in README.md                               //
+    //////////////////////////////////////////////////////////////////
+    check(file != NULL, "log file exists");
+    if (!file)
+    {
+        return 0;
+    }
+    check(fread(magic, sizeof(magic), 1, file) == 1 && fread(header, sizeof(header), 1, file) == 1, "log header");
+    check(header[0] == 1 && header[1] == 1, "log version and channels");
+    while (fread(header, sizeof(header), 1, file) == 1)
+    {
+        check(header[0] == 0 && header[1] > 0 && header[1] <= 4096 && rows + header[1] <= maxRows, "log block header");
+        if (header[0] != 0 || header[1] <= 0 || header[1] > 4096 || rows + header[1] > maxRows
+            || fread(logTime + rows, sizeof(double), header[1], file) != (size_t)header[1]
+            || fread(logData + rows, sizeof(double), header[1], file) != (size_t)header[1])
+        {
+            break;
+        }
+        rows += header[1];
+    }
+    fclose(file);
+    return rows;
+}
+
+static void checkLog(int steps)
+{
+    static double logTime[10000];
+    static double logData[10000];
+    int rows = readLog(TEST_LOG, logTime, logData, 10000);
+    int wrong = 0;
+    //////////////////////////////////////////////////////////////////
+    //  the log must hold step i with value i exactly once and in   //
+    //  order                                                       //
+    //////////////////////////////////////////////////////////////////
+    for (int i = 0; i < rows; i++)
+    {
+        if (logData[i] != i || fabs(logTime[i] - i*0.01) > 1e-9)
+        {
+            wrong++;
+        }
+    }
+    check(rows == steps, "log holds every step once");
+    check(wrong == 0, "log holds the retried values only");
+}
+
+static void testLogAfterRestore()
+{
+    void * table = clara_initDelayWithLog(TEST_LOG);
+    void * state;
+    //////////////////////////////////////////////////////////////////
+    //  save at step 1000, run 5000 steps that get discarded,       //
+    //  restore and retry with the real values                      //
+    //////////////////////////////////////////////////////////////////
+    runSteps(table, 0, 1000, -1);
+    state = clara_getDelayState(table);
+    runSteps(table, 1000, 6000, 99999);
+    clara_setDelayState(table, state);
+    runSteps(table, 1000, 6000, -1);
+    clara_freeDelayState(state);
+    clara_deleteDelay(table);
+    checkLog(6000);
+}
+
+static void testLogAfterRollbackBelowState()
+{
+    void * table = clara_initDelayWithLog(TEST_LOG);
+    void * state;
+    //////////////////////////////////////////////////////////////////
+    //  after saving, the solver goes back a few steps before the   //
+    //  state and rewrites them. restoring must bring back the      //
+    //  saved values, also in the log                               //
+    //////////////////////////////////////////////////////////////////
+    runSteps(table, 0, 1000, -1);
+    state = clara_getDelayState(table);
+    runSteps(table, 995, 3000, 99999);
+    clara_setDelayState(table, state);
+    runSteps(table, 1000, 3000, -1);
+    clara_freeDelayState(state);
+    clara_deleteDelay(table);
+    checkLog(3000);
+}
+
+static void testLogAfterRestoreOutOfOrder()
+{
+    void * table = clara_initDelayWithLog(TEST_LOG);
+    void * first;
+    void * second;
+    //////////////////////////////////////////////////////////////////
+    //  the older state is restored and freed, then a retry is      //
+    //  discarded by restoring the newer state. the log must hold   //
+    //  the history of the newer state, not the retry               //
+    //////////////////////////////////////////////////////////////////
+    runSteps(table, 0, 1000, -1);
+    first = clara_getDelayState(table);
+    runSteps(table, 1000, 2000, -1);
+    second = clara_getDelayState(table);
+    clara_setDelayState(table, first);
+    clara_freeDelayState(first);
+    runSteps(table, 1000, 1500, 99999);
+    clara_setDelayState(table, second);
+    runSteps(table, 2000, 3000, -1);
+    clara_freeDelayState(second);
+    clara_deleteDelay(table);
+    checkLog(3000);
+}
+
+static void testStateValues()
+{
+    void * table = clara_initDelay();
+    void * empty = clara_getDelayState(table);
+    void * state;
+    int wrong = 0;
+    //////////////////////////////////////////////////////////////////
+    //  interpolation after restoring must see the saved history,   //
+    //  also across several chunks                                  //
+    //////////////////////////////////////////////////////////////////
+    runSteps(table, 0, 3000, -1);
+    state = clara_getDelayState(table);
+    runSteps(table, 3000, 5000, 99999);
+    clara_setDelayValue(table, 25.005, 99999);
+    clara_setDelayState(table, state);
+    runSteps(table, 3000, 4000, -1);
+    for (int i = 0; i < 3999; i++)
+    {
+        if (fabs(clara_getDelayValuesAtTime(table, 39.99, 3999, i*0.01 + 0.005) - (i + 0.5)) > 1e-6)
+        {
+            wrong++;
+        }
+    }
+    check(wrong == 0, "interpolation after restore");
+    clara_freeDelayState(state);
+    clara_setDelayState(table, empty);
+    check(clara_getDelayValuesAtTime(table, 0, 42, 0) == 42, "restore of empty table");
+    clara_freeDelayState(empty);
+    clara_deleteDelay(table);
+}
+
+static void testEventLimits()
+{
+    void * table = clara_initDelay();
+    //////////////////////////////////////////////////////////////////
+    //  step from 0 to 1 at t=1: left limit before, right limit at  //
+    //  and after the event time                                    //
+    //////////////////////////////////////////////////////////////////
+    for (int i = 0; i < 10; i++)
+    {
+        clara_setDelayValue(table, i*0.1, 0);
+    }
+    clara_setDelayValue(table, 1.0, 0);
+    clara_setDelayEvent(table, 1.0, 0, 1);
+    for (int i = 11; i <= 20; i++)
+    {
+        clara_setDelayValue(table, i*0.1, 1);
+    }
+    check(valueAt(table, 2.0, 1, 0.95) == 0, "event: left limit before event");
+    check(valueAt(table, 2.0, 1, 1.0 - 1e-6) == 0, "event: left limit just before event");
+    check(valueAt(table, 2.0, 1, 1.0) == 1, "event: right limit at event");
+    check(valueAt(table, 2.0, 1, 1.05) == 1, "event: right limit after event");
+    clara_deleteDelay(table);
+}
+
+static void testEventRepeated()
+{
+    void * table = clara_initDelay();
+    //////////////////////////////////////////////////////////////////
+    //  calling again at the event time updates the stored pair     //
+    //  instead of adding further steps                             //
+    //////////////////////////////////////////////////////////////////
+    clara_setDelayValue(table, 0.5, 0);
+    clara_setDelayEvent(table, 1.0, 0, 1);
+    clara_setDelayEvent(table, 1.0, 2, 3);
+    clara_setDelayValue(table, 1.0, 4);
+    clara_setDelayValue(table, 2.0, 4);
+    check(valueAt(table, 2.0, 4, 0.75) == 1, "repeated event: left limit updated");
+    check(valueAt(table, 2.0, 4, 1.0) == 4, "repeated event: right limit updated by later value");
+    check(valueAt(table, 2.0, 4, 1.5) == 4, "repeated event: no extra steps");
+    clara_deleteDelay(table);
+}
+
+static void testEventRollback()
+{
+    void * table = clara_initDelay();
+    //////////////////////////////////////////////////////////////////
+    //  going back below the event drops the pair, going back to    //
+    //  exactly the event time keeps the left limit and rewrites    //
+    //  the right one                                               //
+    //////////////////////////////////////////////////////////////////
+    clara_setDelayValue(table, 0.0, 0);
+    clara_setDelayEvent(table, 1.0, 0, 1);
+    clara_setDelayValue(table, 1.5, 1);
+    clara_setDelayValue(table, 0.9, 0);
+    clara_setDelayValue(table, 2.0, 0);
+    check(valueAt(table, 2.0, 0, 1.0) == 0, "rollback below event drops pair");
+    check(valueAt(table, 2.0, 0, 1.5) == 0, "rollback below event drops later steps");
+    clara_deleteDelay(table);
+
+    table = clara_initDelay();
+    clara_setDelayValue(table, 0.0, 0);
+    clara_setDelayEvent(table, 1.0, 0, 1);
+    clara_setDelayValue(table, 1.5, 1);
+    clara_setDelayValue(table, 1.0, 5);
+    clara_setDelayValue(table, 2.0, 5);
+    check(valueAt(table, 2.0, 5, 0.5) == 0, "rollback to event keeps left limit");
+    check(valueAt(table, 2.0, 5, 1.0) == 5, "rollback to event rewrites right limit");
+    check(valueAt(table, 2.0, 5, 1.5) == 5, "rollback to event drops later steps");
+    clara_deleteDelay(table);
+}
+
+static void testEventAtStart()
+{
+    void * table = clara_initDelay();
+    //////////////////////////////////////////////////////////////////
+    //  an event at t=0 is the first thing stored                   //
+    //////////////////////////////////////////////////////////////////
+    clara_setDelayEvent(table, 0.0, 3, 7);
+    clara_setDelayValue(table, 1.0, 7);
+    check(valueAt(table, 1.0, 7, 0.0) == 7, "event at t=0: right limit at event");
+    check(valueAt(table, 1.0, 7, 0.5) == 7, "event at t=0: right limit after event");
+    clara_deleteDelay(table);
+}
+
+static void testEventArray()
+{
+    void * tables = clara_initDelayArray(2);
+    volatile int errors = 0;
+    //////////////////////////////////////////////////////////////////
+    //  events go to the indexed table only, indices are 1-based    //
+    //////////////////////////////////////////////////////////////////
+    clara_setDelayEventArray(tables, 1.0, 0, 1, 2);
+    check(clara_getDelayValuesAtTimeArray(tables, 2.0, 1, 1.5, 2) == 1, "event array: indexed table");
+    check(clara_getDelayValuesAtTimeArray(tables, 2.0, 0, 1.5, 1) == 0, "event array: other table untouched");
+    expectError = 1;
+    if (setjmp(errorJump) == 0)
+    {
+        clara_setDelayEventArray(tables, 1.0, 0, 1, 0);
+    }
+    else
+    {
+        errors++;
+    }
+    if (setjmp(errorJump) == 0)
+    {
+        clara_setDelayEventArray(tables, 1.0, 0, 1, 3);
+    }
+    else
+    {
+        errors++;
+    }
+    expectError = 0;
+    check(errors == 2, "event array: index out of bounds");
+    clara_deleteDelayArray(tables);
+}
+
+static void testLogDeepRollback(const char * fileName)
+{
+    static double logTime[10000];
+    static double logData[10000];
+    void * table = clara_initDelayWithLog(fileName);
+    int before = messages;
+    int rows;
+    int wrong = 0;
+    int k = 0;
+    //////////////////////////////////////////////////////////////////
+    //  the first block ends with the left limit of an event at     //
+    //  step 4095. going back behind it must neither write steps    //
+    //  twice nor lose the right limit                              //
+    //////////////////////////////////////////////////////////////////
+    for (int i = 0; i < 4095; i++)
+    {
+        clara_setDelayValue(table, i*0.01, i);
+    }
+    clara_setDelayEvent(table, 4095*0.01, 4095, -4095);
+    for (int i = 4096; i < 4300; i++)
+    {
+        clara_setDelayValue(table, i*0.01, i);
+    }
+    for (int i = 4090; i < 4095; i++)
+    {
+        clara_setDelayValue(table, i*0.01, i);
+    }
+    check(messages - before == 1, "deep rollback behind written block is reported");
+    messages = before;
+    clara_setDelayEvent(table, 4095*0.01, 4095, -4095);
+    for (int i = 4096; i < 6000; i++)
+    {
+        clara_setDelayValue(table, i*0.01, i);
+    }
+    clara_deleteDelay(table);
+
+    rows = readLog(fileName, logTime, logData, 10000);
+    check(rows == 6001, "deep rollback: every step and both limits once");
+    for (int i = 0; i < 6000 && k < rows; i++, k++)
+    {
+        if (logTime[k] != i*0.01 || logData[k] != i)
+        {
+            wrong++;
+        }
+        if (i == 4095 && ++k < rows && (logTime[k] != 4095*0.01 || logData[k] != -4095))
+        {
+            wrong++;
+        }
+    }
+    check(wrong == 0, "deep rollback: log content");
+}
+
+int main(int argc, char * argv[])
+{
+    testEventLimits();
+    testEventRepeated();
+    testEventRollback();
+    testEventAtStart();
+    testEventArray();
+    testLogAfterRestore();
+    testLogAfterRollbackBelowState();
+    testLogAfterRestoreOutOfOrder();
+    testStateValues();
+    //////////////////////////////////////////////////////////////////
+    //  the log of this test is kept if a file name is given, so    //
+    //  claradelay_logdump can be run on it                         //
+    //////////////////////////////////////////////////////////////////
+    testLogDeepRollback(argc > 1 ? argv[1] : TEST_LOG);
+    check(messages == 0, "no warnings");
+    remove(TEST_LOG);
+    if (failures == 0)
+    {
+        printf("all tests passed\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+/* BSD 3-Clause License
+ *
+ * Copyright (c) 2026, XRG Simulation GmbH
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//////////////////////////////////////////////////////////////////////////////
+//  claradelay_logdump: prints a delay log written by clara_initDelayWithLog //
+//  or clara_initDelayArrayWithLog as CSV. the file is memory-mapped and     //
+//  walked block by block, see README.md for the format                      //
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+typedef struct MappedFile
+{
+    const char *bytes;
+    size_t size;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+} MappedFile;
+
+static int mapFile(const char * fileName, MappedFile * mapped)
+{
+#ifdef _WIN32
+    LARGE_INTEGER size;
+    mapped->file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (mapped->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(mapped->file, &size) || size.QuadPart == 0)
+    {
+        return 0;
+    }
+    mapped->size = (size_t)size.QuadPart;
+    mapped->mapping = CreateFileMappingA(mapped->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapped->mapping)
+    {
+        return 0;
+    }
+    mapped->bytes = (const char *)MapViewOfFile(mapped->mapping, FILE_MAP_READ, 0, 0, 0);
+    return mapped->bytes != NULL;
+#else
+    struct stat info;
+    void *bytes;
+    int fd = open(fileName, O_RDONLY);
+    if (fd < 0 || fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        return 0;
+    }
+    mapped->size = (size_t)info.st_size;
+    bytes = mmap(NULL, mapped->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (bytes == MAP_FAILED)
+    {
+        return 0;
+    }
+    mapped->bytes = (const char *)bytes;
+    return 1;
+#endif
+}
+
+static void unmapFile(MappedFile * mapped)
+{
+#ifdef _WIN32
+    UnmapViewOfFile(mapped->bytes);
+    CloseHandle(mapped->mapping);
+    CloseHandle(mapped->file);
+#else
+    munmap((void *)mapped->bytes, mapped->size);
+#endif
+}
+
+int main(int argc, char * argv[])
+{
+    MappedFile mapped;
+    size_t offset;
+    int header[2];
+    int version;
+    int channels;
+    int channel = -1;
+    int i;
+    const double *time;
+    const double *data;
+
+    if (argc < 2 || argc > 3)
+    {
+        fprintf(stderr, "usage: %s <log file> [channel]\n", argv[0]);
+        return 1;
+    }
+    if (argc == 3)
+    {
+        channel = atoi(argv[2]);
+    }
+    if (!mapFile(argv[1], &mapped))
+    {
+        fprintf(stderr, "could not map %s\n", argv[1]);
+        return 1;
+    }
+    //////////////////////////////////////////////////////
+    //  header: 8 byte magic, int version, int channels //
+    //////////////////////////////////////////////////////
+    if (mapped.size < 16 || memcmp(mapped.bytes, "CLRDLOG", 8) != 0)
+    {
+        fprintf(stderr, "%s is no delay log\n", argv[1]);
+        unmapFile(&mapped);
+        return 1;
+    }
+    memcpy(&version, mapped.bytes + 8, sizeof(int));
+    if (version != 1)
+    {
+        fprintf(stderr, "%s has unsupported delay log version %i\n", argv[1], version);
+        unmapFile(&mapped);
+        return 1;
+    }
+    memcpy(&channels, mapped.bytes + 12, sizeof(int));
+    if (channel >= channels)
+    {
+        fprintf(stderr, "channel %i is out of bound %i\n", channel, channels);
+        unmapFile(&mapped);
+        return 1;
+    }
+    printf(channel < 0 ? "channel,time,value\n" : "time,value\n");
+    //////////////////////////////////////////////////////////////////////
+    //  blocks: int channel, int count, count times, count values.      //
+    //  all sizes are multiples of 8, so the columns stay aligned       //
+    //////////////////////////////////////////////////////////////////////
+    for (offset = 16; offset + sizeof(header) <= mapped.size; offset += sizeof(header) + 2*header[1]*sizeof(double))
+    {
+        memcpy(header, mapped.bytes + offset, sizeof(header));
+        if (header[1] < 0 || offset + sizeof(header) + 2*(size_t)header[1]*sizeof(double) > mapped.size)
+        {
+            fprintf(stderr, "truncated block at offset %lu\n", (unsigned long)offset);
+            break;
+        }
+        if (channel >= 0 && header[0] != channel)
+        {
+            continue;
+        }
+        time = (const double *)(mapped.bytes + offset + sizeof(header));
+        data = time + header[1];
+        for (i = 0; i < header[1]; i++)
+        {
+            if (channel < 0)
+            {
+                printf("%i,%.17g,%.17g\n", header[0], time[i], data[i]);
+            }
+            else
+            {
+                printf("%.17g,%.17g\n", time[i], data[i]);
+            }
+        }
+    }
+    unmapFile(&mapped);
+    return 0;
+}
@@ -29,57 +29,360 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "claradelay.h"
 #include "External/ModelicaUtilities.h"
 
 //GLOBAL CONSTANT
 #define MAX_DELAYSTEPS 300000                               //max size of data array in length
+#define CHUNK_SHIFT 9                                       //2^CHUNK_SHIFT steps are stored per chunk
+#define CHUNK_STEPS (1 << CHUNK_SHIFT)
+#define PAGE_SHIFT 6                                        //2^PAGE_SHIFT chunks are referenced per page
+#define PAGE_CHUNKS (1 << PAGE_SHIFT)
+#define LOG_BLOCK_SAMPLES 4096                              //samples per channel and block written to a delay log
+#define LOG_ROLLBACK_STEPS 100                              //latest steps kept out of a delay log since the solver may still discard them
+
+typedef struct DelayLog
+{
+    FILE *file;                                             //shared by all channels of a DelayValues array
+    int ownsFile;
+    int channel;
+    int committedStep;                                      //steps below are buffered or already written
+    int bufferedSamples;
+    int skipWritten;                                        //solver went back behind the file, skip steps already written
+    int skipAtWrittenTime;                                  //samples at writtenTime still to skip, 2 for an event pair
+    int writtenAtTime;                                      //samples in the file with writtenTime
+    double writtenTime;                                     //time of the last sample in the file
+    double time[LOG_BLOCK_SAMPLES];
+    double data[LOG_BLOCK_SAMPLES];
+} DelayLog;
+
+typedef struct DelayChunk
+{
+    int references;                                         //pages sharing this chunk, copied before writing if > 1
+    double time[CHUNK_STEPS];
+    double data[CHUNK_STEPS];
+} DelayChunk;
+
+typedef struct DelayPage
+{
+    int references;                                         //directories sharing this page, copied before writing if > 1
+    DelayChunk *chunks[PAGE_CHUNKS];
+} DelayPage;
+
+typedef struct DelayDirectory
+{
+    int references;                                         //table and saved states sharing this directory, copied before writing if > 1
+    int numberOfChunks;
+    int numberOfPages;
+    int maxPages;
+    DelayPage **pages;
+} DelayDirectory;
+
+typedef struct DelayState DelayState;
 
 typedef struct DelayValue
 {
-    double *data;
-    double *time;
+    DelayDirectory *directory;
+    DelayChunk *cursor;                                     //chunk looked up last, saves the lookup through directory and page
+    int cursorIndex;
     int currentStep;
     int lastPossibleStep;
     int latestStep;
+    DelayLog *log;                                          //NULL unless a delay log is attached
+    DelayState *states;                                     //live states saved from this table, NULL if none
+    int oldestStateStep;                                    //smallest guardStep of these states
 } DelayValue;
 
 typedef struct DelayValues
 {
     int size;
     DelayValue** delayValues;
+    FILE *logFile;
 } DelayValues;
 
+struct DelayState
+{
+    DelayDirectory *directory;                              //shared with the table, see writableChunk()
+    DelayValue *table;                                      //table the state was saved from, NULL once it is deleted
+    DelayState *next;
+    int currentStep;
+    int latestStep;
+    int guardStep;                                          //steps from here on may differ from the table, kept out of the delay log
+};
+
+typedef struct DelayStates
+{
+    int size;
+    DelayState** delayStates;
+} DelayStates;
+
 //GLOBAL VARIABLES
 static int totalDelayValues;//............total length of data-array so far, starting with 500
 static double epsilonStepTime=1e-10;//.........if a time intervall is smaller than this number it gets saved anyway, even if minStepTime is set (userset)
-static int max_DelayValues=500;
+static const char logMagic[8]="CLRDLOG";//.................first bytes of a delay log file, see README.md for the format
+static const int logVersion=1;
 
 //------------------------------------------------------------------------------------------------------//
 //------------------    INTERNAL    FUNCTIONS   (NOT    IN  .H-FILE)    --------------------------------//
 //------------------------------------------------------------------------------------------------------//
+static DelayChunk * lookupChunk(DelayValue * delayData, int index)
+{
+    if (index != delayData->cursorIndex)
+    {
+        delayData->cursor = delayData->directory->pages[index >> PAGE_SHIFT]->chunks[index & (PAGE_CHUNKS - 1)];
+        delayData->cursorIndex = index;
+    }
+    return delayData->cursor;
+}
+
+static double stepTime(DelayValue * delayData, int step)
+{
+    return lookupChunk(delayData, step >> CHUNK_SHIFT)->time[step & (CHUNK_STEPS - 1)];
+}
+
+static double stepData(DelayValue * delayData, int step)
+{
+    return lookupChunk(delayData, step >> CHUNK_SHIFT)->data[step & (CHUNK_STEPS - 1)];
+}
+
+static DelayChunk * newChunk()
+{
+    DelayChunk * chunk = (DelayChunk *)malloc(sizeof(DelayChunk));
+    if (!chunk) ModelicaFormatError("newChunk(): out of memory error.\nPossible Solution:\tTry bigger step size, shorter simulation time, bigger interval length or lesser number of intervals!\n");
+    chunk->references = 1;
+    return chunk;
+}
+
+static void releaseChunk(DelayChunk * chunk)
+{
+    if (--chunk->references == 0)
+    {
+        free(chunk);
+    }
+}
+
+static DelayPage * newPage()
+{
+    DelayPage * page = (DelayPage *)calloc(1, sizeof(DelayPage));
+    if (!page) ModelicaFormatError("newPage(): out of memory error.\n");
+    page->references = 1;
+    return page;
+}
+
+static void releasePage(DelayPage * page)
+{
+    if (--page->references == 0)
+    {
+        for (int i = 0; i < PAGE_CHUNKS && page->chunks[i]; i++)
+        {
+            releaseChunk(page->chunks[i]);
+        }
+        free(page);
+    }
+}
+
+static DelayDirectory * newDirectory(int maxPages)
+{
+    DelayDirectory * directory = (DelayDirectory *)malloc(sizeof(DelayDirectory));
+    if (!directory) ModelicaFormatError("newDirectory(): out of memory error.\n");
+    directory->pages = (DelayPage **)malloc(maxPages*sizeof(DelayPage *));
+    if (!directory->pages) ModelicaFormatError("newDirectory(): out of memory error.\n");
+    directory->references = 1;
+    directory->numberOfChunks = 0;
+    directory->numberOfPages = 0;
+    directory->maxPages = maxPages;
+    return directory;
+}
+
+static void releaseDirectory(DelayDirectory * directory)
+{
+    if (--directory->references == 0)
+    {
+        for (int i = 0; i < directory->numberOfPages; i++)
+        {
+            releasePage(directory->pages[i]);
+        }
+        free(directory->pages);
+        free(directory);
+    }
+}
+
+static DelayDirectory * writableDirectory(DelayValue * delayData)
+{
+    DelayDirectory * directory = delayData->directory;
+    DelayDirectory * copy;
+    //////////////////////////////////////////////////////////////////////
+    //  copy-on-write: a directory shared with a saved state is copied  //
+    //  before its first modification. the copy shares all pages        //
+    //////////////////////////////////////////////////////////////////////
+    if (directory->references > 1)
+    {
+        copy = newDirectory(directory->maxPages);
+        copy->numberOfChunks = directory->numberOfChunks;
+        copy->numberOfPages = directory->numberOfPages;
+        for (int i = 0; i < directory->numberOfPages; i++)
+        {
+            copy->pages[i] = directory->pages[i];
+            copy->pages[i]->references++;
+        }
+        releaseDirectory(directory);
+        delayData->directory = copy;
+        directory = copy;
+    }
+    return directory;
+}
+
+static DelayPage * writablePage(DelayDirectory * directory, int pageIndex)
+{
+    DelayPage * page = directory->pages[pageIndex];
+    DelayPage * copy;
+    if (page->references > 1)
+    {
+        copy = newPage();
+        for (int i = 0; i < PAGE_CHUNKS && page->chunks[i]; i++)
+        {
+            copy->chunks[i] = page->chunks[i];
+            copy->chunks[i]->references++;
+        }
+        releasePage(page);
+        directory->pages[pageIndex] = copy;
+        page = copy;
+    }
+    return page;
+}
+
+static DelayChunk * writableChunk(DelayValue * delayData, int index)
+{
+    DelayPage * page;
+    DelayChunk * chunk;
+    //////////////////////////////////////////////////////////////////////
+    //  without saved states nothing is shared and the chunk can be     //
+    //  written directly. otherwise directory, page and chunk on the    //
+    //  path to the step are copied if a state still refers to them     //
+    //////////////////////////////////////////////////////////////////////
+    if (!delayData->states)
+    {
+        return lookupChunk(delayData, index);
+    }
+    page = writablePage(writableDirectory(delayData), index >> PAGE_SHIFT);
+    chunk = page->chunks[index & (PAGE_CHUNKS - 1)];
+    if (chunk->references > 1)
+    {
+        DelayChunk * copy = newChunk();
+        memcpy(copy->time, chunk->time, sizeof(chunk->time));
+        memcpy(copy->data, chunk->data, sizeof(chunk->data));
+        releaseChunk(chunk);
+        page->chunks[index & (PAGE_CHUNKS - 1)] = copy;
+        chunk = copy;
+    }
+    delayData->cursor = chunk;
+    delayData->cursorIndex = index;
+    return chunk;
+}
+
+static void writeStep(DelayValue * delayData, int step, double time, double value)
+{
+    DelayChunk * chunk = writableChunk(delayData, step >> CHUNK_SHIFT);
+    chunk->time[step & (CHUNK_STEPS - 1)] = time;
+    chunk->data[step & (CHUNK_STEPS - 1)] = value;
+}
+
+static void writeStepData(DelayValue * delayData, int step, double value)
+{
+    writableChunk(delayData, step >> CHUNK_SHIFT)->data[step & (CHUNK_STEPS - 1)] = value;
+}
+
+static void addChunk(DelayValue * delayData)
+{
+    DelayDirectory * directory = writableDirectory(delayData);
+    DelayPage ** pages;
+    DelayPage * page;
+    int index = directory->numberOfChunks;
+    //////////////////////////////////////////////////////////////////////
+    //  the page list grows by doubling, pages and chunks never move,   //
+    //  so stored steps are not copied when the history grows           //
+    //////////////////////////////////////////////////////////////////////
+    if ((index & (PAGE_CHUNKS - 1)) == 0)
+    {
+        if (directory->numberOfPages == directory->maxPages)
+        {
+            pages = (DelayPage **)realloc(directory->pages, 2*directory->maxPages*sizeof(DelayPage *));
+            if (!pages) ModelicaFormatError("addChunk(): out of memory error.\n");
+            directory->pages = pages;
+            directory->maxPages *= 2;
+        }
+        directory->pages[directory->numberOfPages] = newPage();
+        directory->numberOfPages++;
+    }
+    page = writablePage(directory, index >> PAGE_SHIFT);
+    page->chunks[index & (PAGE_CHUNKS - 1)] = newChunk();
+    directory->numberOfChunks++;
+    delayData->lastPossibleStep = directory->numberOfChunks*CHUNK_STEPS;
+}
+
+static void lowerStateGuards(DelayValue * delayData, int step)
+{
+    //////////////////////////////////////////////////////////////////////
+    //  the table goes back to step, so every live state may hold a     //
+    //  different history from there on. none of it may be committed    //
+    //  to the delay log while the state can still be restored          //
+    //////////////////////////////////////////////////////////////////////
+    for (DelayState * state = delayData->states; state; state = state->next)
+    {
+        if (step < state->guardStep)
+        {
+            state->guardStep = step;
+        }
+    }
+    if (step < delayData->oldestStateStep)
+    {
+        delayData->oldestStateStep = step;
+    }
+}
+
+static int commitLimit(DelayValue * delayData)
+{
+    int limit = delayData->currentStep - LOG_ROLLBACK_STEPS;
+    //////////////////////////////////////////////////////////////////////
+    //  a saved state may be restored, so steps within the rollback     //
+    //  window of the lowest guard of the live states are not committed //
+    //////////////////////////////////////////////////////////////////////
+    if (delayData->oldestStateStep - LOG_ROLLBACK_STEPS < limit)
+    {
+        limit = delayData->oldestStateStep - LOG_ROLLBACK_STEPS;
+    }
+    return limit;
+}
+
 static int getStepForInterpolation(DelayValue * delayData, double delayTime, int startStep)
 {
-    int i=0;
-    int step=0;
+    int step=startStep;
+    int firstStep;
+    const double *time;
     //////////////////////////////////////////////////////////////////////
-    //  for-loop iterating downwoards until time from step is less than //
-    //  the wanted delay-time. break as soon as step becomes negative   //
+    //  loop iterating downwoards until time from step is less than     //
+    //  the wanted delay-time. each chunk is scanned directly, since    //
+    //  this is where most of the lookup time is spent                  //
     //////////////////////////////////////////////////////////////////////
-    for (i = 0; i < startStep; i++)
+    while (step > 0)
     {
-        step = startStep-i;
-        if (step < 0)
+        time = lookupChunk(delayData, step >> CHUNK_SHIFT)->time;
+        firstStep = step & ~(CHUNK_STEPS - 1);
+        if (firstStep < 1)
         {
-            ModelicaFormatError("ERROR: step=%i . step<0", 0);
-            return 0;
+            firstStep = 1;
         }
-        if (delayTime >= delayData->time[step])
+        for (; step >= firstStep; step--)
         {
-            return step;
+            if (delayTime >= time[step & (CHUNK_STEPS - 1)])
+            {
+                return step;
+            }
         }
     }
     return 0;
@@ -131,20 +434,19 @@ static int findStepOfTime(DelayValue * delayData, double time, int startStep)
         //  it's very first position instead of appending                   //
         //////////////////////////////////////////////////////////////////////
         step = startStep - i;
-        if(testDoubleForEquality(delayData->time[step], time))
+        if(testDoubleForEquality(stepTime(delayData, step), time))
         {
             return step;
         }
-        else if (delayData->time[step] < time)
+        else if (stepTime(delayData, step) < time)
         {
-            if (delayData->time[step + 1] > time || testDoubleForEquality(time, delayData->time[step + 1])) //strangly a double of test for equality became necessary
+            if (stepTime(delayData, step + 1) > time || testDoubleForEquality(time, stepTime(delayData, step + 1))) //strangly a double of test for equality became necessary
             {
                 return step + 1;
             }
             else
             {
-                ModelicaFormatMessage("WARNING: findStepOfTime(). Wasn't able to find appropriate step for time %f. Overwritten step %i with time %f instead of step %i with time %f\nThis might effect accuracy of your simulation.\n",time, step, delayData->time[step], step+1, delayData
-                                      ->time[step+1]);
+                ModelicaFormatMessage("WARNING: findStepOfTime(). Wasn't able to find appropriate step for time %f. Overwritten step %i with time %f instead of step %i with time %f\nThis might effect accuracy of your simulation.\n",time, step, stepTime(delayData, step), step+1, stepTime(delayData, step+1));
                 return step;
             }
 
@@ -166,9 +468,9 @@ static int insertData(DelayValue * delayData, double time, double value)
     //  time given by function is smaller than latest saved time, so insertion is needed //
     ///////////////////////////////////////////////////////////////////////////////////////
     insertStep = findStepOfTime(delayData, time, delayData->latestStep);
-    if (testDoubleForEquality(time, delayData->time[insertStep]))
+    if (testDoubleForEquality(time, stepTime(delayData, insertStep)))
     {
-        delayData->data[insertStep] = value;
+        writeStepData(delayData, insertStep, value);
     }
     else
     {
@@ -178,16 +480,193 @@ static int insertData(DelayValue * delayData, double time, double value)
         //////////////////////////////////////////////////////////////////////////
         for (i = delayData->currentStep; i > insertStep; i--)
         {
-            delayData->data[i] = delayData->data[i - 1];
-            delayData->time[i] = delayData->time[i - 1];
+            writeStep(delayData, i, stepTime(delayData, i - 1), stepData(delayData, i - 1));
         }
-        delayData->data[insertStep] = value;
-        delayData->time[insertStep] = time;
+        writeStep(delayData, insertStep, time, value);
         return 1;
     }
     return 0;
 }
 
+static FILE * openLogFile(const char * fileName, int channels)
+{
+    FILE * file;
+    //////////////////////////////////////////////////////////////////
+    //  create the log file and write its header: magic, version    //
+    //  and number of channels                                      //
+    //////////////////////////////////////////////////////////////////
+    file = fopen(fileName, "wb");
+    if (!file)
+    {
+        ModelicaFormatError("openLogFile(): could not open delay log file %s\n", fileName);
+        return NULL;
+    }
+    if (fwrite(logMagic, sizeof(logMagic), 1, file) != 1 || fwrite(&logVersion, sizeof(int), 1, file) != 1
+        || fwrite(&channels, sizeof(int), 1, file) != 1)
+    {
+        ModelicaFormatError("openLogFile(): could not write header of delay log file %s\n", fileName);
+    }
+    return file;
+}
+
+static void attachLog(DelayValue * delayData, FILE * file, int ownsFile, int channel)
+{
+    DelayLog * log = (DelayLog *)malloc(sizeof(DelayLog));
+    if (!log) ModelicaFormatError("attachLog(): out of memory error.\n");
+    log->file = file;
+    log->ownsFile = ownsFile;
+    log->channel = channel;
+    log->committedStep = 0;
+    log->bufferedSamples = 0;
+    log->skipWritten = 0;
+    log->skipAtWrittenTime = 0;
+    log->writtenAtTime = 0;
+    log->writtenTime = 0.;
+    delayData->log = log;
+}
+
+static void writeLogBlock(DelayLog * log)
+{
+    int header[2];
+    int atTime;
+    //////////////////////////////////////////////////////////////////////
+    //  one block per buffer: channel and count followed by the time    //
+    //  column and the value column. this is the only place doing I/O   //
+    //////////////////////////////////////////////////////////////////////
+    if (log->bufferedSamples == 0)
+    {
+        return;
+    }
+    header[0] = log->channel;
+    header[1] = log->bufferedSamples;
+    if (fwrite(header, sizeof(header), 1, log->file) != 1
+        || fwrite(log->time, sizeof(double), log->bufferedSamples, log->file) != (size_t)log->bufferedSamples
+        || fwrite(log->data, sizeof(double), log->bufferedSamples, log->file) != (size_t)log->bufferedSamples)
+    {
+        ModelicaFormatMessage("WARNING: writeLogBlock(): could not write delay log. Logged history is incomplete.\n");
+        log->bufferedSamples = 0;
+        return;
+    }
+    //////////////////////////////////////////////////////////////////////
+    //  remember the last time in the file and how many samples carry  //
+    //  it. left and right limit of an event share their time and may  //
+    //  end up in different blocks                                      //
+    //////////////////////////////////////////////////////////////////////
+    for (atTime = 1; atTime < log->bufferedSamples && log->time[log->bufferedSamples - 1 - atTime] == log->time[log->bufferedSamples - 1]; atTime++);
+    if (atTime == log->bufferedSamples && log->writtenAtTime > 0 && log->time[0] == log->writtenTime)
+    {
+        atTime += log->writtenAtTime;
+    }
+    log->writtenTime = log->time[log->bufferedSamples - 1];
+    log->writtenAtTime = atTime;
+    log->bufferedSamples = 0;
+}
+
+static void commitLog(DelayLog * log, DelayValue * delayData, int uptoStep)
+{
+    DelayChunk * chunk;
+    int offset;
+    int count;
+    //////////////////////////////////////////////////////////////////////
+    //  copy every step below uptoStep into the block buffer. these     //
+    //  steps are older than any point the solver may still go back to  //
+    //////////////////////////////////////////////////////////////////////
+    //////////////////////////////////////////////////////////////////////
+    //  after going back behind the file, steps are written again only  //
+    //  once they follow its last sample: older ones are skipped, and   //
+    //  of those with the same time as many as the file already holds.  //
+    //  time in the file thus never goes back and the right limit of an //
+    //  event whose left limit ended a block is not lost                //
+    //////////////////////////////////////////////////////////////////////
+    if (log->skipWritten)
+    {
+        while (log->committedStep < uptoStep)
+        {
+            double time = stepTime(delayData, log->committedStep);
+            if (time < log->writtenTime)
+            {
+                log->committedStep++;
+            }
+            else if (time == log->writtenTime && log->skipAtWrittenTime > 0)
+            {
+                log->committedStep++;
+                log->skipAtWrittenTime--;
+            }
+            else
+            {
+                log->skipWritten = 0;
+                break;
+            }
+        }
+        if (log->skipWritten)
+        {
+            return;
+        }
+    }
+    while (log->committedStep < uptoStep)
+    {
+        chunk = lookupChunk(delayData, log->committedStep >> CHUNK_SHIFT);
+        offset = log->committedStep & (CHUNK_STEPS - 1);
+        count = uptoStep - log->committedStep;
+        if (count > LOG_BLOCK_SAMPLES - log->bufferedSamples)
+        {
+            count = LOG_BLOCK_SAMPLES - log->bufferedSamples;
+        }
+        if (count > CHUNK_STEPS - offset)
+        {
+            count = CHUNK_STEPS - offset;
+        }
+        memcpy(log->time + log->bufferedSamples, chunk->time + offset, count*sizeof(double));
+        memcpy(log->data + log->bufferedSamples, chunk->data + offset, count*sizeof(double));
+        log->bufferedSamples += count;
+        log->committedStep += count;
+        if (log->bufferedSamples == LOG_BLOCK_SAMPLES)
+        {
+            writeLogBlock(log);
+        }
+    }
+}
+
+static void rewindLog(DelayLog * log, int step)
+{
+    int discarded;
+    //////////////////////////////////////////////////////////////////////
+    //  the solver went back further than LOG_ROLLBACK_STEPS. samples   //
+    //  still in the buffer can be dropped, written ones can't. these   //
+    //  stay in the file and commitLog() continues after them           //
+    //////////////////////////////////////////////////////////////////////
+    if (step >= log->committedStep)
+    {
+        return;
+    }
+    discarded = log->committedStep - step;
+    if (discarded > log->bufferedSamples)
+    {
+        ModelicaFormatMessage("WARNING: rewindLog(): solver stepped back behind already written delay log. Log may contain discarded samples.\n");
+        discarded = log->bufferedSamples;
+        log->skipWritten = 1;
+        log->skipAtWrittenTime = log->writtenAtTime;
+    }
+    log->bufferedSamples -= discarded;
+    log->committedStep = step;
+}
+
+static void closeLog(DelayValue * delayData)
+{
+    DelayLog * log = delayData->log;
+    ////////////////////////////////////////////////////////////////
+    //  simulation is over, so every stored step is committed now //
+    ////////////////////////////////////////////////////////////////
+    commitLog(log, delayData, delayData->currentStep);
+    writeLogBlock(log);
+    if (log->ownsFile)
+    {
+        fclose(log->file);
+    }
+    free(log);
+    delayData->log = NULL;
+}
+
 //------------------------------------------------------------------------------------------------------//
 //-------------------------------    FUNCTIONS FROM .H-FILE    -----------------------------------------//
 //------------------------------------------------------------------------------------------------------//
@@ -202,11 +681,28 @@ void * clara_initDelay()
     //  this is the creation of such a pointer. pointing to the table-struct            //
     //////////////////////////////////////////////////////////////////////////////////////
     DelayValue * ptr = (DelayValue *)malloc(sizeof(DelayValue));
-    ptr->time = (double *)malloc(max_DelayValues*sizeof(double));
-    ptr->data = (double *)malloc(max_DelayValues*sizeof(double));
-    ptr->lastPossibleStep = max_DelayValues;
+    ptr->directory = newDirectory(1);
+    ptr->cursorIndex = -1;
+    ptr->states = NULL;
+    ptr->oldestStateStep = INT_MAX;
+    addChunk(ptr);
     ptr->currentStep = -1;
     ptr->latestStep = -1;
+    ptr->log = NULL;
+    return ptr;
+}
+
+void * clara_initDelayWithLog(const char * logFileName)
+{
+    //////////////////////////////////////////////////////////////////////////
+    //  same as clara_initDelay(), but streams the committed history to    //
+    //  logFileName. an empty file name disables the log                   //
+    //////////////////////////////////////////////////////////////////////////
+    DelayValue * ptr = (DelayValue *)clara_initDelay();
+    if (logFileName && logFileName[0] != '\0')
+    {
+        attachLog(ptr, openLogFile(logFileName, 1), 1, 0);
+    }
     return ptr;
 }
 
@@ -217,8 +713,18 @@ void clara_deleteDelay(void *ptr_to_table)
     //  the data. this is the destructor function.                              //
     //////////////////////////////////////////////////////////////////////////////
     DelayValue * delayData = (DelayValue *)ptr_to_table;
-    free(delayData->data);
-    free(delayData->time);
+    if (delayData->log)
+    {
+        closeLog(delayData);
+    }
+    //////////////////////////////////////////////////////////////////////
+    //  live states keep their storage, they just lose their table      //
+    //////////////////////////////////////////////////////////////////////
+    for (DelayState * state = delayData->states; state; state = state->next)
+    {
+        state->table = NULL;
+    }
+    releaseDirectory(delayData->directory);
     free(delayData);
 }
 
@@ -227,6 +733,7 @@ void * clara_initDelayArray(int size)
     DelayValues* ptr = (DelayValues*) malloc(sizeof(DelayValues));
     ptr->delayValues = (DelayValue**)malloc(size*sizeof(DelayValue*));
     ptr->size = size;
+    ptr->logFile = NULL;
     for(int i=0;i<size;i++)
     {
         ptr->delayValues[i] = clara_initDelay();
@@ -234,6 +741,20 @@ void * clara_initDelayArray(int size)
     return ptr;
 }
 
+void * clara_initDelayArrayWithLog(int size, const char * logFileName)
+{
+    DelayValues* ptr = (DelayValues*) clara_initDelayArray(size);
+    if (logFileName && logFileName[0] != '\0')
+    {
+        ptr->logFile = openLogFile(logFileName, size);
+        for(int i=0;i<size;i++)
+        {
+            attachLog(ptr->delayValues[i], ptr->logFile, 0, i);
+        }
+    }
+    return ptr;
+}
+
 void clara_deleteDelayArray(void *ptr_to_tables)
 {
     DelayValues * delayValues = (DelayValues*)ptr_to_tables;
@@ -241,7 +762,12 @@ void clara_deleteDelayArray(void *ptr_to_tables)
     {
         clara_deleteDelay(delayValues->delayValues[i]);
     }
+    if (delayValues->logFile)
+    {
+        fclose(delayValues->logFile);
+    }
     free(delayValues->delayValues);
+    free(delayValues);
 }
 
 void clara_setDelayValue(void * ptr_to_table, double time, double value)
@@ -265,16 +791,12 @@ void clara_setDelayValue(void * ptr_to_table, double time, double value)
         delayData->currentStep = 0;
     }
     //////////////////////////////////////////////////////////
-    //  reallocating memory in case of reaching close to    //
-    //  the end of current memory                           //
+    //  adding a chunk in case of reaching close to the     //
+    //  end of current memory                               //
     //////////////////////////////////////////////////////////
     if(delayData->lastPossibleStep - delayData->currentStep <= 10)
     {
-        delayData->lastPossibleStep += 500;
-        delayData->time = (double*) realloc(delayData->time, delayData->lastPossibleStep*sizeof(double));
-        if (!delayData->time) ModelicaFormatError("getDelayID(): out of memory error.\nPossible Solution:\tTry bigger step size, shorter simulation time, bigger interval length or lesser number of intervals!\n");
-        delayData->data=(double*) realloc(delayData->data, delayData->lastPossibleStep*sizeof(double));
-        if (!delayData->data) ModelicaFormatError("getDelayID(): out of memory error.");
+        addChunk(delayData);
     }
     //////////////////////
     //  safety request  //
@@ -286,28 +808,101 @@ void clara_setDelayValue(void * ptr_to_table, double time, double value)
     //////////////////////////////////////////
     //  saving current time at current step //
     //////////////////////////////////////////
-    if (delayData->latestStep >= 0 && testDoubleForEquality(delayData->time[delayData->latestStep], time))  //overwrite latest step if times are equal
+    if (delayData->latestStep >= 0 && testDoubleForEquality(stepTime(delayData, delayData->latestStep), time))  //overwrite latest step if times are equal
     {
-        delayData->data[delayData->latestStep] = value;
+        if (delayData->states)
+        {
+            lowerStateGuards(delayData, delayData->latestStep);
+        }
+        writeStepData(delayData, delayData->latestStep, value);
     }
-    else if (delayData->currentStep == 0 || delayData->time[delayData->latestStep] < time)  //append, if everything is allright
+    else if (delayData->currentStep == 0 || stepTime(delayData, delayData->latestStep) < time)  //append, if everything is allright
     {
-        delayData->time[delayData->currentStep] = time;
-        delayData->data[delayData->currentStep] = value;
+        writeStep(delayData, delayData->currentStep, time, value);
         delayData->latestStep = delayData->currentStep;
         delayData->currentStep++;
     }
     else                                                                                    //else: find step to overwrite and reset list to that step
     {
         step = findStepOfTime(delayData, time, delayData->latestStep);
-        delayData->time[step] = time;
-        delayData->data[step] = value;
+        if (delayData->states)
+        {
+            lowerStateGuards(delayData, step);
+        }
+        if (delayData->log)
+        {
+            rewindLog(delayData->log, step);
+        }
+        writeStep(delayData, step, time, value);
         delayData->latestStep = step;
         delayData->currentStep = step + 1;
         //  the following code does not work! Inserting is not possible since equality isn't properly testable. Also referencing for Modelica does not work then.
         //        delayData->currentStep += insertData(delayData, time, value);
         //        delayData->latestStep = delayData->currentStep - 1;
     }
+    if (delayData->log && commitLimit(delayData) > delayData->log->committedStep)
+    {
+        commitLog(delayData->log, delayData, commitLimit(delayData));
+    }
+}
+
+void clara_setDelayEvent(void * ptr_to_table, double time, double valueLeft, double valueRight)
+{
+    DelayValue * delayData = (DelayValue *)ptr_to_table;
+    ///////////////////////
+    //  safety-requests  //
+    ///////////////////////
+    if (!ptr_to_table)  //nullptr received
+    {
+        ModelicaFormatMessage("setDelayEvent: Use initDelay function befor call setDelayEvent!\n");
+        return;
+    }
+    //////////////////////////////////////////////////////////////////////
+    //  the left limit is stored like any other sample. this also drops //
+    //  every step after time in case the solver went back in time      //
+    //////////////////////////////////////////////////////////////////////
+    clara_setDelayValue(delayData, time, valueLeft);
+    //////////////////////////////////////////////////////////////////////
+    //  event at this time has been stored before: latest step holds    //
+    //  the right limit and the step below it the left limit            //
+    //////////////////////////////////////////////////////////////////////
+    if (delayData->latestStep > 0 && testDoubleForEquality(stepTime(delayData, delayData->latestStep - 1), time))
+    {
+        if (delayData->states)
+        {
+            lowerStateGuards(delayData, delayData->latestStep - 1);
+        }
+        writeStepData(delayData, delayData->latestStep - 1, valueLeft);
+        writeStepData(delayData, delayData->latestStep, valueRight);
+        return;
+    }
+    //////////////////////////////////////////////////////////////////////
+    //  append the right limit with the very same time as the left one. //
+    //  getStepForInterpolation() returns the upper of both steps, so   //
+    //  requests before the event see the left limit and requests at or //
+    //  after the event see the right limit. memory is guaranteed by    //
+    //  the reserve kept in clara_setDelayValue()                       //
+    //////////////////////////////////////////////////////////////////////
+    writeStep(delayData, delayData->currentStep, stepTime(delayData, delayData->latestStep), valueRight);
+    delayData->latestStep = delayData->currentStep;
+    delayData->currentStep++;
+}
+
+void clara_setDelayEventArray(void * ptr_to_tables, double time, double valueLeft, double valueRight, int index)
+{
+    ///////////////////////
+    //  safety-requests  //
+    ///////////////////////
+    if (!ptr_to_tables)
+    {
+        ModelicaFormatError("setDelayEventArray: Use initDelayArray function befor call setDelayEventArray!\n");
+    }
+    DelayValues* delayValues = (DelayValues*) ptr_to_tables;
+    if (index < 1 || index - 1 >= delayValues->size)
+    {
+        ModelicaFormatError("Index %i is out of bound %i", index - 1, delayValues->size);
+    }
+    clara_setDelayEvent(delayValues->delayValues[index - 1], time, valueLeft, valueRight);
 }
 
 void clara_getDelayValuesAtTimes(void * ptr_to_table, double time, double value,  double wantedDelayTimes[], int getTimes_size, double *result, int result_size)
@@ -364,9 +959,9 @@ void clara_getDelayValuesAtTimes(void * ptr_to_table, double time, double value,
         {
             result[i] = value;
         }
-        else if (wantedDelayTimes[i] < delayData->time[0] && delayData->currentStep >= 0)
+        else if (wantedDelayTimes[i] < stepTime(delayData, 0) && delayData->currentStep >= 0)
         {
-            result[i] = delayData->data[0];
+            result[i] = stepData(delayData, 0);
         }
         else
         {
@@ -391,17 +986,17 @@ void clara_getDelayValuesAtTimes(void * ptr_to_table, double time, double value,
             //////////////////////////////////////////////////////////////////////////////
             if (lastRoundsStep == delayData->latestStep)
             {
-                value1 = delayData->data[lastRoundsStep];
-                time1 = delayData->time[lastRoundsStep];
+                value1 = stepData(delayData, lastRoundsStep);
+                time1 = stepTime(delayData, lastRoundsStep);
                 value2 = value;
                 time2 = time;
             }
             else
             {
-                value1 = delayData->data[lastRoundsStep];
-                time1 = delayData->time[lastRoundsStep];
-                value2 = delayData->data[lastRoundsStep + 1];
-                time2 = delayData->time[lastRoundsStep + 1];
+                value1 = stepData(delayData, lastRoundsStep);
+                time1 = stepTime(delayData, lastRoundsStep);
+                value2 = stepData(delayData, lastRoundsStep + 1);
+                time2 = stepTime(delayData, lastRoundsStep + 1);
             }
             if (time1 <= wantedDelayTimes[i] && time2 >= wantedDelayTimes[i])
             {
@@ -409,11 +1004,11 @@ void clara_getDelayValuesAtTimes(void * ptr_to_table, double time, double value,
             }
             else if (time1 >= time)
             {
-                result[i] = delayData->data[delayData->latestStep];
+                result[i] = stepData(delayData, delayData->latestStep);
             }
             else
             {
-                result[i] = interpolate(0, delayData->data[0], time, delayData->data[delayData->latestStep], wantedDelayTimes[i]);
+                result[i] = interpolate(0, stepData(delayData, 0), time, stepData(delayData, delayData->latestStep), wantedDelayTimes[i]);
             }
         }
     }
@@ -451,3 +1046,154 @@ double clara_getDelayValuesAtTimeArray(void * ptr_to_tables, double time, double
     result = clara_getDelayValuesAtTime(ptr, time, value, getTime);
     return result;
 }
+
+void * clara_getDelayState(void * ptr_to_table)
+{
+    DelayValue * delayData = (DelayValue *)ptr_to_table;
+    DelayState * state;
+    ///////////////////////
+    //  safety-requests  //
+    ///////////////////////
+    if (!ptr_to_table)
+    {
+        ModelicaFormatError("getDelayState: Use initDelay function befor call getDelayState!\n");
+    }
+    state = (DelayState *)malloc(sizeof(DelayState));
+    if (!state) ModelicaFormatError("getDelayState(): out of memory error.\n");
+    //////////////////////////////////////////////////////////////////////
+    //  a state shares the directory of the table instead of copying    //
+    //  the history. whoever writes to shared storage afterwards copies //
+    //  the path to the written step first, see writableChunk()         //
+    //////////////////////////////////////////////////////////////////////
+    state->directory = delayData->directory;
+    state->directory->references++;
+    state->currentStep = delayData->currentStep;
+    state->latestStep = delayData->latestStep;
+    state->guardStep = delayData->currentStep;
+    state->table = delayData;
+    state->next = delayData->states;
+    delayData->states = state;
+    if (state->guardStep < delayData->oldestStateStep)
+    {
+        delayData->oldestStateStep = state->guardStep;
+    }
+    return state;
+}
+
+void clara_setDelayState(void * ptr_to_table, void * ptr_to_state)
+{
+    DelayValue * delayData = (DelayValue *)ptr_to_table;
+    DelayState * state = (DelayState *)ptr_to_state;
+    ///////////////////////
+    //  safety-requests  //
+    ///////////////////////
+    if (!ptr_to_table || !ptr_to_state)
+    {
+        ModelicaFormatError("setDelayState: Use initDelay and getDelayState function befor call setDelayState!\n");
+    }
+    if (state->table != delayData)
+    {
+        ModelicaFormatError("setDelayState(): state was not saved from this table\n");
+    }
+    state->directory->references++;
+    releaseDirectory(delayData->directory);
+    delayData->directory = state->directory;
+    delayData->cursorIndex = -1;
+    delayData->lastPossibleStep = delayData->directory->numberOfChunks*CHUNK_STEPS;
+    delayData->currentStep = state->currentStep;
+    delayData->latestStep = state->latestStep;
+    lowerStateGuards(delayData, delayData->currentStep);
+    if (delayData->log)
+    {
+        rewindLog(delayData->log, delayData->currentStep > 0 ? delayData->currentStep : 0);
+    }
+}
+
+void clara_freeDelayState(void * ptr_to_state)
+{
+    DelayState * state = (DelayState *)ptr_to_state;
+    DelayState ** link;
+    DelayValue * delayData;
+    if (!state)
+    {
+        return;
+    }
+    delayData = state->table;
+    if (delayData)
+    {
+        ////////////////////////////////////////////////////////////////
+        //  unlink the state and find the oldest one still alive      //
+        ////////////////////////////////////////////////////////////////
+        for (link = &delayData->states; *link != state; link = &(*link)->next);
+        *link = state->next;
+        delayData->oldestStateStep = INT_MAX;
+        for (DelayState * live = delayData->states; live; live = live->next)
+        {
+            if (live->guardStep < delayData->oldestStateStep)
+            {
+                delayData->oldestStateStep = live->guardStep;
+            }
+        }
+    }
+    releaseDirectory(state->directory);
+    free(state);
+}
+
+void * clara_getDelayArrayState(void * ptr_to_tables)
+{
+    DelayValues * delayValues = (DelayValues*)ptr_to_tables;
+    DelayStates * states;
+    ///////////////////////
+    //  safety-requests  //
+    ///////////////////////
+    if (!ptr_to_tables)
+    {
+        ModelicaFormatError("getDelayArrayState: Use initDelayArray function befor call getDelayArrayState!\n");
+    }
+    states = (DelayStates *)malloc(sizeof(DelayStates));
+    if (!states) ModelicaFormatError("getDelayArrayState(): out of memory error.\n");
+    states->delayStates = (DelayState **)malloc(delayValues->size*sizeof(DelayState *));
+    if (!states->delayStates) ModelicaFormatError("getDelayArrayState(): out of memory error.\n");
+    states->size = delayValues->size;
+    for (int i = 0; i < delayValues->size; i++)
+    {
+        states->delayStates[i] = clara_getDelayState(delayValues->delayValues[i]);
+    }
+    return states;
+}
+
+void clara_setDelayArrayState(void * ptr_to_tables, void * ptr_to_states)
+{
+    DelayValues * delayValues = (DelayValues*)ptr_to_tables;
+    DelayStates * states = (DelayStates *)ptr_to_states;
+    ///////////////////////
+    //  safety-requests  //
+    ///////////////////////
+    if (!ptr_to_tables || !ptr_to_states)
+    {
+        ModelicaFormatError("setDelayArrayState: Use initDelayArray and getDelayArrayState function befor call setDelayArrayState!\n");
+    }
+    if (states->size != delayValues->size)
+    {
+        ModelicaFormatError("setDelayArrayState(): size error, state of %i tables given for %i tables\n", states->size, delayValues->size);
+    }
+    for (int i = 0; i < delayValues->size; i++)
+    {
+        clara_setDelayState(delayValues->delayValues[i], states->delayStates[i]);
+    }
+}
+
+void clara_freeDelayArrayState(void * ptr_to_states)
+{
+    DelayStates * states = (DelayStates *)ptr_to_states;
+    if (!states)
+    {
+        return;
+    }
+    for (int i = 0; i < states->size; i++)
+    {
+        clara_freeDelayState(states->delayStates[i]);
+    }
+    free(states->delayStates);
+    free(states);
+}
@@ -37,16 +37,27 @@ extern "C" {
 #endif
 
 void * clara_initDelay();
+void * clara_initDelayWithLog(const char * logFileName);
 void clara_deleteDelay(void * ptr_to_table);
 void * clara_initDelayArray(int size);
+void * clara_initDelayArrayWithLog(int size, const char * logFileName);
 void clara_deleteDelayArray(void * ptr_to_table);
 void clara_setDelayValue(void * ptr_to_table, double time, double value);
+void clara_setDelayEvent(void * ptr_to_table, double time, double valueLeft, double valueRight);
+void clara_setDelayEventArray(void * ptr_to_tables, double time, double valueLeft, double valueRight,
+                              int index);
 void clara_getDelayValuesAtTimes(void * ptr_to_table, double time, double value,
         double getTimes[], int getTimes_size, double *result, int result_size);
 double clara_getDelayValuesAtTime(void * ptr_to_table, double time, double value,
         double getTime);
 double clara_getDelayValuesAtTimeArray(void * ptr_to_tables, double time, double value,
                                   double getTime, int index);
+void * clara_getDelayState(void * ptr_to_table);
+void clara_setDelayState(void * ptr_to_table, void * ptr_to_state);
+void clara_freeDelayState(void * ptr_to_state);
+void * clara_getDelayArrayState(void * ptr_to_tables);
+void clara_setDelayArrayState(void * ptr_to_tables, void * ptr_to_states);
+void clara_freeDelayArrayState(void * ptr_to_states);
 
 #ifdef __cplusplus
 }